@@ -2,6 +2,9 @@
 #define IVANP_ARG_DEF_HH
 
 #include "default_arg_parser.hh"
+#include "parallel.hh"
+#include "columns.hh"
+#include "intern.hh"
 
 namespace ivanp { namespace args {
 
@@ -25,6 +28,18 @@ struct req { };
 template <typename T> struct is_req : std::false_type { };
 template <> struct is_req<req> : std::true_type { };
 
+struct pure { };
+template <typename T> struct is_pure : std::false_type { };
+template <> struct is_pure<pure> : std::true_type { };
+
+struct ordered { };
+template <typename T> struct is_ordered : std::false_type { };
+template <> struct is_ordered<ordered> : std::true_type { };
+
+struct par { unsigned nthreads = 0; };
+template <typename T> struct is_par : std::false_type { };
+template <> struct is_par<par> : std::true_type { };
+
 template <typename... Args> class switch_init {
   std::tuple<Args...> args;
   template <typename T, size_t... I>
@@ -47,7 +62,9 @@ struct is_switch_init<switch_init<T...>> : std::true_type { };
 
 template <typename T> struct is_parser {
   template <typename F>
-  using type = typename is_callable<F,const char*,T&>::type;
+  using type = std::integral_constant<bool,
+    is_callable<F,const char*,T&>::value ||
+    is_callable<F,const char*,value_type_of_t<T>&>::value >;
 };
 
 } // end namespace _
@@ -58,6 +75,10 @@ constexpr _::multi multi(unsigned n) noexcept { return {n}; }
 constexpr _::multi multi() noexcept { return {}; }
 constexpr _::pos pos() noexcept { return {}; }
 constexpr _::req req() noexcept { return {}; }
+constexpr _::pure pure() noexcept { return {}; }
+constexpr _::ordered ordered() noexcept { return {}; }
+constexpr _::par par(unsigned nthreads) noexcept { return {nthreads}; }
+constexpr _::par par() noexcept { return {}; }
 template <typename... Args>
 inline _::switch_init<std::decay_t<Args>...> switch_init(Args&&... args) {
   return { std::forward_as_tuple(std::forward<Args>(args)...) };
@@ -70,55 +91,229 @@ namespace detail {
 // and assigning new values to recepients via pointers
 // These are created as a result of calling parser::operator()
 
+template <typename T, typename Mixins, typename Index>
+struct parses_whole: std::false_type { };
+template <typename T, typename Mixins, size_t I>
+struct parses_whole<T,Mixins,std::index_sequence<I>>
+: std::integral_constant<bool,
+    is_callable<std::tuple_element_t<I,Mixins>,const char*,T&>::value> { };
+
 struct arg_def_base {
   std::string descr;
   unsigned count = 0;
+  unsigned index = 0; // position in parser::arg_defs
+  column* col = nullptr; // batch output, replaces the recepient
 
   arg_def_base(std::string&& descr): descr(std::move(descr)) { }
   virtual ~arg_def_base() { }
   virtual void parse(const char* arg) = 0;
+  // arg is interned, so its id identifies its contents
+  virtual void parse_interned(interned arg) { parse(arg.str); }
+  virtual void forget() { } // drop memoized values
+  virtual void flush() { } // convert deferred values
+  virtual void discard() { } // drop deferred values of a failed parse
+  virtual std::unique_ptr<column> make_column() const { return nullptr; }
   virtual std::string name() const { return descr; } // FIXME
   virtual bool is_switch() = 0;
   virtual unsigned min() const noexcept = 0;
   virtual unsigned max() const noexcept = 0;
 };
 
+// arg_def depends on the default conversion, so it is declared in an
+// inline namespace named after it, which becomes part of its symbols
+// Objects built with different conversions, like libargs and a user
+// of extern templates, then fail to link instead of mixing parsers
+inline namespace ARGS_PARSER_CONVERSION {
+
 template <typename T, typename... Mixins>
 class arg_def final: public arg_def_base, Mixins... {
   T *x; // recepient of parsed value
 
   using mixins = std::tuple<Mixins...>;
   template <template<typename> typename Pred>
-  using index_t = first_index_of<Pred,mixins>;
+  using index_t = first_index_of_t<Pred,mixins>;
   template <typename Seq>
   using mix_t = std::tuple_element_t<seq_head<Seq>::value,mixins>;
 
   // parser ---------------------------------------------------------
   using parser_index = index_t<_::is_parser<T>::template type>;
-  template <typename index = parser_index>
+  template <typename U, typename index = parser_index>
   inline std::enable_if_t<index::size()==1>
-  parse_impl(const char* arg) const {
-    mix_t<index>::operator()(arg,*x);
+  parse_impl(const char* arg, U& x) const {
+    mix_t<index>::operator()(arg,x);
   }
-  template <typename index = parser_index>
+  template <typename U, typename index = parser_index>
   inline std::enable_if_t<index::size()==0>
-  parse_impl(const char* arg) const {
-    arg_parser<T>::parse(arg,*x);
+  parse_impl(const char* arg, U& x) const {
+    arg_parser<U>::parse(arg,x);
+  }
+
+  // value ----------------------------------------------------------
+  // containers receive one element per value,
+  // unless the parser takes the whole container
+  static constexpr bool elementwise = is_container<T>::value &&
+    !parses_whole<T,mixins,parser_index>::value;
+  using value_type = std::conditional_t<elementwise,value_type_of_t<T>,T>;
+
+  // f writes the value into the recepient
+  // a new element is removed again if f throws
+  template <typename F, bool E = elementwise>
+  inline std::enable_if_t<E> write(F&& f) {
+    x->emplace_back();
+    try {
+      f(x->back());
+    } catch (...) {
+      x->pop_back();
+      throw;
+    }
+  }
+  template <typename F, bool E = elementwise>
+  inline std::enable_if_t<!E> write(F&& f) { f(*x); }
+
+  // column ---------------------------------------------------------
+  // with col set, values are converted into a temporary and appended
+  // to the column, the recepient is not touched
+  template <typename V = value_type>
+  inline std::enable_if_t<column_traits<V>::kind!=0,std::unique_ptr<column>>
+  make_column_impl() const {
+    const char kind = column_traits<V>::kind;
+    return std::make_unique<column>(
+      name(), kind, kind=='s' ? 0 : sizeof(V), elementwise || max()>1 );
+  }
+  template <typename V = value_type>
+  inline std::enable_if_t<column_traits<V>::kind==0,std::unique_ptr<column>>
+  make_column_impl() const { return nullptr; }
+
+  template <typename V>
+  inline std::enable_if_t<
+    std::is_same<V,value_type>::value && column_traits<V>::kind!=0
+  > column_add(const V& v) { column_traits<V>::add(*col,v); }
+  template <typename V>
+  inline std::enable_if_t<
+    !std::is_same<V,value_type>::value || column_traits<V>::kind==0
+  > column_add(const V&) noexcept { }
+
+  // f writes the value, into the column if set or else the recepient
+  template <typename F, typename V = value_type>
+  inline std::enable_if_t<column_traits<V>::kind!=0> store(F&& f) {
+    if (col) {
+      V v{};
+      f(v);
+      column_traits<V>::add(*col,v);
+    } else write(std::forward<F>(f));
+  }
+  template <typename F, typename V = value_type>
+  inline std::enable_if_t<column_traits<V>::kind==0> store(F&& f) {
+    write(std::forward<F>(f));
+  }
+
+  // parallel -------------------------------------------------------
+  // values are collected during matching and converted in flush()
+  using par_index = index_t<_::is_par>;
+  std::conditional_t<par_index::size(),
+    std::vector<const char*>, std::tuple<> > pending;
+
+  template <typename index = par_index>
+  inline std::enable_if_t<index::size()==0> parse_arg(const char* arg) {
+    store([&](value_type& v){ parse_impl(arg,v); });
+  }
+  template <typename index = par_index>
+  inline std::enable_if_t<index::size()==1> parse_arg(const char* arg) {
+    pending.push_back(arg);
+  }
+
+  template <typename index = par_index>
+  inline std::enable_if_t<index::size()==0> discard_impl() noexcept { }
+  template <typename index = par_index>
+  inline std::enable_if_t<index::size()==1> discard_impl() noexcept {
+    pending.clear();
   }
 
+  template <typename index = par_index>
+  inline std::enable_if_t<index::size()==0> flush_impl() noexcept { }
+  template <typename index = par_index>
+  inline std::enable_if_t<index::size()==1> flush_impl() {
+    const auto args = std::move(pending);
+    pending.clear();
+    if (args.empty()) return;
+    if (col) return flush_column(args);
+    const size_t n0 = x->size();
+    x->resize(n0+args.size()); // pre-size, so each slot is written once
+    try {
+      parallel_for(args.size(), mix_t<index>::nthreads, [&](size_t i){
+        parse_impl(args[i],(*x)[n0+i]);
+      });
+    } catch (...) { // drop default and partly converted values
+      x->resize(n0);
+      throw;
+    }
+  }
+
+  template <typename V = value_type>
+  inline std::enable_if_t<column_traits<V>::kind!=0>
+  flush_column(const std::vector<const char*>& args) {
+    std::unique_ptr<V[]> vals(new V[args.size()]());
+    parallel_for(args.size(), mix_t<par_index>::nthreads, [&](size_t i){
+      parse_impl(args[i],vals[i]);
+    });
+    for (size_t i=0; i<args.size(); ++i) column_traits<V>::add(*col,vals[i]);
+  }
+  template <typename V = value_type>
+  inline std::enable_if_t<column_traits<V>::kind==0>
+  flush_column(const std::vector<const char*>&) noexcept { }
+
+  // memo -----------------------------------------------------------
+  // converted values, looked up by the id of the interned token
+  // default parsers are pure, custom ones have to be marked with pure()
+  static constexpr bool memoize = !par_index::size() &&
+    (!parser_index::size() || index_t<_::is_pure>::size()) &&
+    std::is_copy_assignable<value_type>::value;
+  struct memo_t {
+    std::vector<unsigned> slot; // token id -> 1 + index in vals, 0 if none
+    std::vector<value_type> vals;
+  };
+  std::conditional_t<memoize, memo_t, std::tuple<> > memo;
+
+  template <bool M = memoize>
+  inline std::enable_if_t<M> parse_interned_impl(interned arg) {
+    if (arg.id >= memo.slot.size()) memo.slot.resize(arg.id+1);
+    if (const unsigned i = memo.slot[arg.id]) {
+      const value_type& val = memo.vals[i-1];
+      if (col) column_add(val);
+      else write([&](value_type& v){ v = val; });
+    } else store([&](value_type& v){
+      parse_impl(arg.str,v);
+      memo.vals.push_back(v);
+      memo.slot[arg.id] = memo.vals.size();
+    });
+  }
+  template <bool M = memoize>
+  inline std::enable_if_t<!M> parse_interned_impl(interned arg) {
+    parse_arg(arg.str);
+  }
+
+  template <bool M = memoize>
+  inline std::enable_if_t<M> forget_impl() noexcept {
+    memo.slot.clear();
+    memo.vals.clear();
+  }
+  template <bool M = memoize>
+  inline std::enable_if_t<!M> forget_impl() noexcept { }
+
   // switch ---------------------------------------------------------
   using switch_init_index = index_t<_::is_switch_init>;
   template <typename U = T> inline std::enable_if_t<
     std::is_same<U,bool>::value,
-  bool> is_switch_impl() noexcept {
-    (*x) = true;
+  bool> is_switch_impl() {
+    if (col) column_add(true);
+    else (*x) = true;
     ++count;
     return true;
   }
   template <typename U = T> inline std::enable_if_t<
     !std::is_same<U,bool>::value && switch_init_index::size(),
   bool> is_switch_impl() {
-    mix_t<switch_init_index>::construct(*x);
+    switch_construct();
     ++count;
     return true;
   }
@@ -126,6 +321,20 @@ class arg_def final: public arg_def_base, Mixins... {
     !std::is_same<U,bool>::value && !switch_init_index::size(),
   bool> is_switch_impl() const noexcept { return false; }
 
+  // a container switch adds each of its elements to the column
+  template <bool E = elementwise>
+  inline std::enable_if_t<E> switch_construct() {
+    if (col) {
+      T tmp;
+      mix_t<switch_init_index>::construct(tmp);
+      for (const value_type& v : tmp) column_add(v);
+    } else mix_t<switch_init_index>::construct(*x);
+  }
+  template <bool E = elementwise>
+  inline std::enable_if_t<!E> switch_construct() {
+    store([this](value_type& v){ mix_t<switch_init_index>::construct(v); });
+  }
+
   // name -----------------------------------------------------------
   using name_index = index_t<_::is_name>;
   template <typename index = name_index>
@@ -138,28 +347,17 @@ class arg_def final: public arg_def_base, Mixins... {
   }
 
   // min max --------------------------------------------------------
-  inline unsigned min() const noexcept {
-    return switch_init_index::size();
-  }
+  // number of values or switch occurrences allowed per parse
+  unsigned min() const noexcept;
 
   using multi_index = index_t<_::is_multi>;
   template <typename index = multi_index>
-  inline std::enable_if_t<
-    index::size()==1,
-  unsigned> max() noexcept {
-    return mix_t<multi_index>::num;
+  inline std::enable_if_t<index::size()==1,unsigned> max_impl() const noexcept {
+    return mix_t<index>::num;
   }
   template <typename index = multi_index>
-  inline std::enable_if_t<
-    index::size()==0 && 
-  unsigned> max() const noexcept { return 0; }
-
-  inline unsigned max() const noexcept {
-
-    return switch_init_index::size();
-  }
-
-    return std::integral_constant<unsigned,switch_init_index::size() >::value;
+  inline std::enable_if_t<index::size()==0,unsigned> max_impl() const noexcept {
+    return 1;
   }
 
   // ----------------------------------------------------------------
@@ -167,16 +365,57 @@ public:
   template <typename... M>
   arg_def(T* x, std::string&& descr, M&&... m)
   : arg_def_base(std::move(descr)), Mixins(std::forward<M>(m))..., x(x)
-  { set_count(); }
+  { }
+
+  void parse(const char* arg);
+  void parse_interned(interned arg);
+  void forget();
+  void flush();
+  void discard();
+  std::unique_ptr<column> make_column() const;
+  bool is_switch();
+  std::string name() const;
+  unsigned max() const noexcept;
+};
 
-  inline void parse(const char* arg) {
-    parse_impl(arg);
-    ++count;
-  }
+// Virtual overrides are not inline,
+// so that extern templates can suppress their instantiation
 
-  inline bool is_switch() { return is_switch_impl(); }
-  inline std::string name() const { return name_impl(); }
-};
+template <typename T, typename... Mixins>
+void arg_def<T,Mixins...>::parse(const char* arg) {
+  parse_arg(arg);
+  ++count;
+}
+template <typename T, typename... Mixins>
+void arg_def<T,Mixins...>::parse_interned(interned arg) {
+  parse_interned_impl(arg);
+  ++count;
+}
+template <typename T, typename... Mixins>
+void arg_def<T,Mixins...>::forget() { forget_impl(); }
+template <typename T, typename... Mixins>
+void arg_def<T,Mixins...>::flush() { flush_impl(); }
+template <typename T, typename... Mixins>
+void arg_def<T,Mixins...>::discard() { discard_impl(); }
+
+template <typename T, typename... Mixins>
+std::unique_ptr<column> arg_def<T,Mixins...>::make_column() const {
+  return make_column_impl();
+}
+
+template <typename T, typename... Mixins>
+bool arg_def<T,Mixins...>::is_switch() { return is_switch_impl(); }
+template <typename T, typename... Mixins>
+std::string arg_def<T,Mixins...>::name() const { return name_impl(); }
+
+template <typename T, typename... Mixins>
+unsigned arg_def<T,Mixins...>::min() const noexcept {
+  return index_t<_::is_req>::size();
+}
+template <typename T, typename... Mixins>
+unsigned arg_def<T,Mixins...>::max() const noexcept { return max_impl(); }
+
+} // end namespace ARGS_PARSER_CONVERSION
 
 // Traits -----------------------------------------------------------
 // CA. Can have arguments
@@ -62,6 +62,13 @@ inline arg_type get_arg_type(const std::string& arg) noexcept {
 
 // Matcher factories ------------------------------------------------
 
+template <typename T>
+inline std::enable_if_t<std::is_convertible<T,std::string>::value,std::string>
+arg_match_str(const T& x) { return x; }
+template <typename T>
+inline std::enable_if_t<!std::is_convertible<T,std::string>::value,std::string>
+arg_match_str(const T&) { return { }; }
+
 using arg_match_type = std::pair<const arg_match_base*,arg_type>;
 template <typename T> struct arg_match_tag { using type = T; };
 
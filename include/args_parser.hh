@@ -7,6 +7,9 @@
 #include <memory>
 #include <type_traits>
 #include <stdexcept>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
 
 #define TEST(var) \
   std::cout <<"\033[36m"<< #var <<"\033[0m"<< " = " << var << std::endl;
@@ -21,8 +24,12 @@ struct error : std::runtime_error {
 }}
 
 #include "utility.hh"
+#include "bitmask.hh"
 #include "arg_match.hh"
 #include "arg_def.hh"
+#include "extern_templates.hh"
+#include "command_line.hh"
+#include "suggest.hh"
 
 namespace ivanp { namespace args {
 
@@ -32,6 +39,40 @@ class parser {
     std::unique_ptr<const detail::arg_match_base>,
     detail::arg_def_base*
   >>,3> matchers;
+  std::vector<detail::arg_def_base*> deferred; // par() definitions
+  std::vector<detail::arg_def_base*> pos_defs; // pos() definitions
+
+  // lookup tables, built by freeze() before parsing
+  bool frozen = false;
+  std::vector<detail::arg_def_base*> positional; // numbered slots
+  detail::arg_def_base* variadic = nullptr; // trailing pos() with multi()
+  std::vector<std::pair<std::string,detail::arg_def_base*>> long_names;
+  mutable std::unique_ptr<detail::name_table> suggestions;
+
+  // order in which context matchers are tried, and their hit counts
+  // Matchers of ordered() definitions stay in place, the ones between
+  // them are assumed not to overlap and may be sorted by hits
+  bool adaptive_order = false;
+  std::vector<unsigned> context_order; // indices into matchers[context_arg]
+  std::vector<unsigned long> context_hits;
+  detail::bitmask ordered_defs;
+
+  detail::command_line cmd_line; // scratch for parse_command_line()
+
+  // interned values and memoized conversions for batch parsing
+  bool interning = false;
+  detail::intern_table strings;
+  // const char* recepients, which keep pointers to their arguments
+  detail::bitmask pointer_defs;
+
+  // columnar batch output, one row per parse()
+  std::vector<std::unique_ptr<detail::column>> cols;
+  std::uint64_t rows = 0;
+
+  // post-parse validation masks, indexed by arg_def_base::index
+  detail::bitmask required, seen, over;
+  std::vector<detail::bitmask> exclusive_groups;
+  std::vector<std::pair<unsigned,detail::bitmask>> dependencies;
 
   template <typename T, typename... Props>
   inline auto* add_arg_def(T* x, std::string&& descr, Props&&... p) {
@@ -48,6 +89,9 @@ class parser {
     UNIQUE_PROP_ASSERT(pos)
     UNIQUE_PROP_ASSERT(req)
     UNIQUE_PROP_ASSERT(multi)
+    UNIQUE_PROP_ASSERT(par)
+    UNIQUE_PROP_ASSERT(ordered)
+    UNIQUE_PROP_ASSERT(pure)
 
 #undef UNIQUE_PROP_ASSERT
 
@@ -62,14 +106,29 @@ class parser {
       switch_init_i,
       multi_i,
       pos_i,
-      req_i
+      req_i,
+      par_i,
+      ordered_i,
+      pure_i
     >;
 
+    static_assert( !par_i::size() || is_indexable_container<T>::value,
+      "\033[33mpar() requires a resizable container recepient"
+      " with element references, such as std::vector<double>\033[0m");
+
     static_assert( seq::size() == sizeof...(Props),
       "\033[33munrecognized option in program argument definition\033[0m");
 
     auto *arg_def = detail::make_arg_def(x, std::move(descr), props, seq{});
+    arg_def->index = arg_defs.size();
     arg_defs.emplace_back(arg_def);
+    if (req_i::size()) required.set(arg_def->index);
+    if (par_i::size()) deferred.push_back(arg_def);
+    if (pos_i::size()) pos_defs.push_back(arg_def);
+    if (ordered_i::size()) ordered_defs.set(arg_def->index);
+    if (std::is_same<value_type_of_t<T>,const char*>::value)
+      pointer_defs.set(arg_def->index);
+    frozen = false;
 
     using arg_def_t = std::decay_t<decltype(*arg_def)>;
     type_size<arg_def_t>();
@@ -81,8 +140,11 @@ class parser {
   inline void add_arg_match(
     Matcher&& matcher, detail::arg_def_base* arg_def
   ) {
+    std::string str = detail::arg_match_str(matcher);
     auto&& m = detail::make_arg_match(std::forward<Matcher>(matcher));
     matchers[m.second].emplace_back(std::move(m.first),arg_def);
+    if (m.second==detail::long_arg)
+      long_names.emplace_back(std::move(str),arg_def);
   }
   template <typename... M, size_t... I>
   inline void add_arg_matches(
@@ -96,8 +158,64 @@ class parser {
 #endif
   }
 
+  void freeze();
+  void reorder_context();
+  bool is_ordered(unsigned m) const;
+  detail::arg_def_base* find(const char* opt) const;
+  detail::arg_def_base* find_long(const char* arg) const;
+  void validate() const;
+  std::string suggest(const char* arg) const;
+  // scratch: argv is overwritten by the next parse_command_line()
+  void parse_row(int argc, char const * const * argv, bool scratch);
+  void parse_args(int argc, char const * const * argv, bool scratch);
+
 public:
   void parse(int argc, char const * const * argv);
+
+  // split a shell-quoted command line, including the program name,
+  // and parse the words as argv
+  // The words are reused by the next call, so values of const char*
+  // recepients are interned, and stay valid until clear_interned()
+  void parse_command_line(const char* str, size_t len);
+#if __cplusplus >= 201703L
+  void parse_command_line(std::string_view str) {
+    parse_command_line(str.data(),str.size());
+  }
+#else
+  void parse_command_line(const std::string& str) {
+    parse_command_line(str.data(),str.size());
+  }
+#endif
+
+  // at most one of the options may be given
+  parser& exclusive(std::initializer_list<const char*> opts);
+  // if opt is given, all of deps must be given as well
+  parser& depends(const char* opt, std::initializer_list<const char*> deps);
+
+  // reorder context matchers by hit frequency after each parse
+  parser& adaptive(bool on = true) noexcept {
+    adaptive_order = on;
+    return *this;
+  }
+  // intern values, so that repeated ones are looked up instead of
+  // converted again; conversions are memoized for pure parsers
+  // Interned strings stay valid until clear_interned()
+  parser& intern(bool on = true) noexcept {
+    interning = on;
+    return *this;
+  }
+  void clear_interned();
+
+  // write the values of each parse() as a row of per-definition
+  // columns, instead of to the recepients
+  // Definitions of types without a column representation are
+  // written to their recepients as usual
+  parser& batch(bool on = true);
+  void write_columns(const std::string& filename) const;
+
+  // export or reload the learned order of context matchers
+  std::vector<unsigned> matcher_order();
+  parser& matcher_order(std::vector<unsigned> order);
   // void help(); // FIXME
 
   template <typename T, typename... Props>
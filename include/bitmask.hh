@@ -0,0 +1,88 @@
+#ifndef IVANP_ARGS_BITMASK_HH
+#define IVANP_ARGS_BITMASK_HH
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+namespace ivanp { namespace args {
+namespace detail {
+
+// Bit mask over argument definition indices ------------------------
+// Missing words are treated as zeros, so masks of different sizes
+// can be combined
+
+class bitmask {
+  using word = std::uint64_t;
+  static constexpr unsigned word_bits = 64;
+  std::vector<word> w;
+
+public:
+  bitmask() = default;
+  explicit bitmask(size_t n): w((n+word_bits-1)/word_bits) { }
+
+  inline void resize(size_t n) { w.resize((n+word_bits-1)/word_bits); }
+  inline void reset() noexcept { std::fill(w.begin(),w.end(),0); }
+
+  inline void set(size_t i) {
+    if (i/word_bits >= w.size()) w.resize(i/word_bits+1);
+    w[i/word_bits] |= word(1) << (i%word_bits);
+  }
+  inline bool test(size_t i) const noexcept {
+    return i/word_bits < w.size() && (w[i/word_bits] >> (i%word_bits)) & 1;
+  }
+
+  inline const std::vector<word>& words() const noexcept { return w; }
+
+  inline bool any() const noexcept {
+    for (word x : w) if (x) return true;
+    return false;
+  }
+  inline size_t count() const noexcept {
+    size_t n = 0;
+    for (word x : w) n += __builtin_popcountll(x);
+    return n;
+  }
+
+  // any bit of this & ~o
+  inline bool any_but(const bitmask& o) const noexcept {
+    const size_t n = std::min(w.size(),o.w.size());
+    for (size_t i=0; i<n; ++i) if (w[i] & ~o.w[i]) return true;
+    for (size_t i=n; i<w.size(); ++i) if (w[i]) return true;
+    return false;
+  }
+  // number of bits of this & o
+  inline size_t count_and(const bitmask& o) const noexcept {
+    const size_t n = std::min(w.size(),o.w.size());
+    size_t c = 0;
+    for (size_t i=0; i<n; ++i) c += __builtin_popcountll(w[i] & o.w[i]);
+    return c;
+  }
+
+  inline bitmask operator&(const bitmask& o) const {
+    bitmask r;
+    r.w.resize(std::min(w.size(),o.w.size()));
+    for (size_t i=0; i<r.w.size(); ++i) r.w[i] = w[i] & o.w[i];
+    return r;
+  }
+  // this & ~o
+  inline bitmask operator-(const bitmask& o) const {
+    bitmask r(*this);
+    const size_t n = std::min(w.size(),o.w.size());
+    for (size_t i=0; i<n; ++i) r.w[i] &= ~o.w[i];
+    return r;
+  }
+
+  // call f(i) for every set bit, in increasing order
+  template <typename F>
+  inline void for_each(F&& f) const {
+    for (size_t k=0; k<w.size(); ++k)
+      for (word x=w[k]; x; x &= x-1)
+        f(k*word_bits + __builtin_ctzll(x));
+  }
+};
+
+}
+}}
+
+#endif
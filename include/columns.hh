@@ -0,0 +1,86 @@
+#ifndef IVANP_ARGS_COLUMNS_HH
+#define IVANP_ARGS_COLUMNS_HH
+
+#include <cstdint>
+#include <cstring>
+
+namespace ivanp { namespace args {
+namespace detail {
+
+// Columns of batch parse results -----------------------------------
+// One column per definition, one row per parse()
+// Fixed-width values have one slot per row, unless the definition
+// takes several values, in which case row_offsets delimit each row's
+// values. Strings are stored as bytes delimited by value_offsets.
+// Rows where the definition was given are set in valid
+
+struct column {
+  std::string name;
+  char kind;          // 'b' bool, 'i' signed, 'u' unsigned, 'f' float, 's' string
+  std::uint8_t width; // bytes per fixed-width value, 0 for strings
+  bool multi;
+
+  std::vector<char> values;
+  std::vector<std::uint64_t> value_offsets { 0 }; // strings only
+  std::vector<std::uint64_t> row_offsets { 0 }; // multi only
+  bitmask valid;
+  std::uint64_t rows = 0, nvalues = 0;
+
+  column(std::string name, char kind, std::uint8_t width, bool multi)
+  : name(std::move(name)), kind(kind), width(width), multi(multi) { }
+
+  inline void add(const void* v) {
+    const char* p = static_cast<const char*>(v);
+    values.insert(values.end(),p,p+width);
+    ++nvalues;
+  }
+  inline void add(const char* str, size_t len) {
+    values.insert(values.end(),str,str+len);
+    value_offsets.push_back(values.size());
+    ++nvalues;
+  }
+
+  void end_row(bool given);
+  void rollback(); // drop values of an unfinished row
+};
+
+template <typename V, typename = void>
+struct column_traits { static constexpr char kind = 0; };
+template <typename V>
+struct column_traits<V, std::enable_if_t<std::is_arithmetic<V>::value>> {
+  static constexpr char kind =
+    std::is_same<V,bool>::value ? 'b' :
+    std::is_floating_point<V>::value ? 'f' :
+    std::is_signed<V>::value ? 'i' : 'u';
+  static void add(column& c, V v) { c.add(&v); }
+};
+template <> struct column_traits<std::string> {
+  static constexpr char kind = 's';
+  static void add(column& c, const std::string& v) { c.add(v.data(),v.size()); }
+};
+template <> struct column_traits<const char*> {
+  static constexpr char kind = 's';
+  static void add(column& c, const char* v) { c.add(v,strlen(v)); }
+};
+
+// File layout ------------------------------------------------------
+// All integers are 64 bit in native byte order, sections 8 byte aligned,
+// and all offsets are from the beginning of the file, so that a
+// mapped file can be read in place
+//
+// header:    "ARGSCOL1", rows, columns
+// directory: per column, 10 words
+//   kind | width<<8 | multi<<16, name, name length,
+//   valid, row_offsets, value_offsets, values,
+//   number of values, size of values in bytes, reserved
+//   (absent sections have offset 0)
+// sections:  name, valid bits (ceil(rows/64) words),
+//   row_offsets (rows+1), value_offsets (values+1), values
+
+void write_columns(const std::string& filename,
+  const std::vector<std::unique_ptr<column>>& cols, std::uint64_t rows);
+
+}
+}}
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef IVANP_ARGS_COMMAND_LINE_HH
+#define IVANP_ARGS_COMMAND_LINE_HH
+
+namespace ivanp { namespace args {
+namespace detail {
+
+// Words of a shell-quoted command line -----------------------------
+// Words are written null-terminated into one buffer, which is reused
+// by subsequent calls to split(), so argv() is only valid until then
+
+class command_line {
+  std::string buf;
+  std::vector<size_t> offsets;
+  std::vector<const char*> ptrs;
+
+public:
+  void split(const char* str, size_t len);
+
+  inline int argc() const noexcept { return ptrs.size(); }
+  inline const char* const* argv() const noexcept { return ptrs.data(); }
+};
+
+}
+}}
+
+#endif
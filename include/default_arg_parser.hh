@@ -4,8 +4,10 @@
 #ifdef ARGS_PARSER_BOOST_LEXICAL_CAST
 // #if __has_include(<boost/lexical_cast.hpp>)
 #include <boost/lexical_cast.hpp>
+#define ARGS_PARSER_CONVERSION lexical_cast_conversion
 #else
 #include <sstream>
+#define ARGS_PARSER_CONVERSION istream_conversion
 #endif
 
 namespace ivanp { namespace args {
@@ -26,6 +28,18 @@ template <typename T> struct arg_parser {
   }
 };
 
+// strings take the whole argument, no conversion needed
+template <> struct arg_parser<std::string> {
+  inline static void parse(const char* arg, std::string& x) { x = arg; }
+};
+// points into argv, or into the parser's intern table when interning
+// or parsing a command line string
+template <> struct arg_parser<const char*> {
+  inline static void parse(const char* arg, const char*& x) noexcept {
+    x = arg;
+  }
+};
+
 }
 }}
 
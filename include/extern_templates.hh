@@ -0,0 +1,36 @@
+#ifndef IVANP_ARGS_EXTERN_TEMPLATES_HH
+#define IVANP_ARGS_EXTERN_TEMPLATES_HH
+
+// Argument definitions for common recepient types and properties
+// are explicitly instantiated in libargs (src/instances.cc)
+// Define ARGS_PARSER_EXTERN_TEMPLATES when linking against libargs
+// to use those instead of instantiating them in every translation unit
+// libargs is built with ARGS_PARSER_BOOST_LEXICAL_CAST, and users
+// have to define it as well, or the instances are not found at link time
+
+#define ARGS_PARSER_INSTANCES_T(F,T) \
+  F(T) \
+  F(T,_::name) \
+  F(T,_::multi) \
+  F(T,_::pos) \
+  F(T,_::req) \
+  F(T,_::multi,_::pos)
+
+#define ARGS_PARSER_INSTANCES(F) \
+  ARGS_PARSER_INSTANCES_T(F,bool) \
+  ARGS_PARSER_INSTANCES_T(F,int) \
+  ARGS_PARSER_INSTANCES_T(F,unsigned) \
+  ARGS_PARSER_INSTANCES_T(F,long) \
+  ARGS_PARSER_INSTANCES_T(F,double) \
+  ARGS_PARSER_INSTANCES_T(F,std::string)
+
+#ifdef ARGS_PARSER_EXTERN_TEMPLATES
+namespace ivanp { namespace args {
+#define ARGS_PARSER_EXTERN(...) \
+  extern template class detail::arg_def<__VA_ARGS__>;
+ARGS_PARSER_INSTANCES(ARGS_PARSER_EXTERN)
+#undef ARGS_PARSER_EXTERN
+}}
+#endif
+
+#endif
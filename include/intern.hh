@@ -0,0 +1,44 @@
+#ifndef IVANP_ARGS_INTERN_HH
+#define IVANP_ARGS_INTERN_HH
+
+namespace ivanp { namespace args {
+namespace detail {
+
+// String interning -------------------------------------------------
+// Maps equal strings to one null-terminated copy, whose address stays
+// valid until clear(). Open addressing with linear probing; the copies
+// live in large blocks, so interning a new string rarely allocates
+// Each distinct string gets a sequential id, usable as an array index
+
+struct interned {
+  const char* str;
+  unsigned id;
+};
+
+class intern_table {
+  struct entry {
+    size_t hash;
+    const char* str; // nullptr if empty slot
+    size_t len;
+    unsigned id;
+  };
+  std::vector<entry> slots; // size is a power of 2
+  size_t n = 0;
+
+  std::vector<std::unique_ptr<char[]>> blocks;
+  char* cur = nullptr;
+  size_t left = 0;
+
+  const char* store(const char* str, size_t len);
+  void grow();
+
+public:
+  interned intern(const char* str);
+  void clear() noexcept;
+  inline size_t size() const noexcept { return n; }
+};
+
+}
+}}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef IVANP_ARGS_PARALLEL_HH
+#define IVANP_ARGS_PARALLEL_HH
+
+namespace ivanp { namespace args {
+namespace detail {
+
+// Parallel loop ----------------------------------------------------
+// Calls f(i) for every i in [0,n) on a work-stealing set of threads
+// Each thread owns a contiguous range of indices and, when it runs
+// out, steals the upper half of another thread's remaining range
+// If any call throws, the exception from the smallest failing index
+// is rethrown after all threads have joined
+// nthreads = 0 uses std::thread::hardware_concurrency()
+// Every thread gets at least parallel_grain indices, so short loops,
+// like most parse() calls, run on the calling thread without
+// starting any
+
+constexpr size_t parallel_grain = 1024;
+
+void parallel_for_impl(
+  size_t n, unsigned nthreads, void(*f)(void*,size_t), void* ctx);
+
+template <typename F>
+inline void parallel_for(size_t n, unsigned nthreads, F&& f) {
+  parallel_for_impl(n, nthreads, [](void* ctx, size_t i){
+    (*static_cast<std::remove_reference_t<F>*>(ctx))(i);
+  }, &f);
+}
+
+}
+}}
+
+#endif
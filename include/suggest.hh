@@ -0,0 +1,30 @@
+#ifndef IVANP_ARGS_SUGGEST_HH
+#define IVANP_ARGS_SUGGEST_HH
+
+#include <cstdint>
+
+namespace ivanp { namespace args {
+namespace detail {
+
+// Suggestions for unknown options ----------------------------------
+// Names are packed into one buffer. Edit distances to a query are
+// computed with Myers' bit-parallel algorithm: the query is encoded
+// once as per-character bit masks, and each name then costs one
+// step of a few word operations per character
+
+class name_table {
+  std::string buf;
+  std::vector<std::pair<std::uint32_t,std::uint32_t>> names; // offset, length
+
+public:
+  void add(const std::string& name);
+
+  // up to n names nearest to query, within max_dist edits
+  std::vector<std::string> nearest(
+    const char* query, unsigned max_dist, unsigned n=3) const;
+};
+
+}
+}}
+
+#endif
@@ -6,48 +6,75 @@ namespace ivanp {
 template <typename... T> struct make_void { typedef void type; };
 template <typename... T> using void_t = typename make_void<T...>::type;
 
+// Index metafunctions ---------------------------------------------
+// These are flat: predicates are evaluated once in a pack expansion,
+// and the resulting sequences are read from constexpr arrays,
+// instead of recursing over tuple elements
+
+template <typename T, T... I>
+constexpr T seq_at(std::integer_sequence<T,I...>, size_t n) noexcept {
+  const T a[] = { I..., T() };
+  return n < sizeof...(I) ? a[n] : T();
+}
+
 template <template<typename> typename Pred, typename Tuple>
-class get_indices_of {
-  static constexpr size_t size = std::tuple_size<Tuple>::value;
-  template <size_t I, size_t... II> struct impl {
-    using type = std::conditional_t<
-      Pred<std::tuple_element_t<I,Tuple>>::value,
-      typename impl<I+1, II..., I>::type,
-      typename impl<I+1, II...>::type >;
-  };
-  template <size_t... II> struct impl<size,II...> {
-    using type = std::index_sequence<II...>;
-  };
+class get_indices_of;
+template <template<typename> typename Pred, typename... T>
+class get_indices_of<Pred,std::tuple<T...>> {
+  static constexpr size_t count() noexcept {
+    const bool m[] = { Pred<T>::value..., false };
+    size_t n = 0;
+    for (size_t i=0; i<sizeof...(T); ++i) n += m[i];
+    return n;
+  }
+  static constexpr size_t nth(size_t n) noexcept {
+    const bool m[] = { Pred<T>::value..., false };
+    for (size_t i=0; i<sizeof...(T); ++i)
+      if (m[i] && n--==0) return i;
+    return sizeof...(T);
+  }
+  template <size_t... J>
+  static std::index_sequence<nth(J)...> impl(std::index_sequence<J...>);
 public:
-  using type = typename impl<0>::type;
+  using type = decltype(impl(std::make_index_sequence<count()>{}));
 };
 template <template<typename> typename Pred, typename Tuple>
 using get_indices_of_t = typename get_indices_of<Pred,Tuple>::type;
 
+template <typename Seq> struct seq_first { using type = Seq; };
+template <typename T, T Head, T... I>
+struct seq_first<std::integer_sequence<T,Head,I...>> {
+  using type = std::integer_sequence<T,Head>;
+};
+
 template <template<typename> typename Pred, typename Tuple>
-class first_index_of {
-  static constexpr size_t size = std::tuple_size<Tuple>::value;
-  template <size_t I> impl {
-    using type = std::conditional_t<
-      Pred<std::tuple_element_t<I,Tuple>>::value,
-      std::index_sequence<I>,
-      typename impl<I+1>::type >;
-  };
-  template <> impl<size> { using type = std::index_sequence<>; };
-public:
-  using type = typename impl<0>::type;
+struct first_index_of {
+  using type = typename seq_first<get_indices_of_t<Pred,Tuple>>::type;
 };
 template <template<typename> typename Pred, typename Tuple>
 using first_index_of_t = typename first_index_of<Pred,Tuple>::type;
 
-template <typename... SS> struct seq_join;
-template <typename T, size_t... I1, size_t... I2>
-struct seq_join<std::integer_sequence<T,I1...>,std::integer_sequence<T,I2...>> {
-  using type = std::integer_sequence<T,I1...,I2...>;
+template <typename S, typename... SS>
+class seq_join {
+  using T = typename S::value_type;
+  static constexpr size_t size() noexcept {
+    const size_t sizes[] = { S::size(), SS::size()... };
+    size_t n = 0;
+    for (size_t s : sizes) n += s;
+    return n;
+  }
+  static constexpr T at(size_t n) noexcept {
+    const size_t sizes[] = { S::size(), SS::size()... };
+    size_t k = 0;
+    for (; n >= sizes[k]; ++k) n -= sizes[k];
+    const T vals[] = { seq_at(S{},n), seq_at(SS{},n)... };
+    return vals[k];
+  }
+  template <size_t... J>
+  static std::integer_sequence<T,at(J)...> impl(std::index_sequence<J...>);
+public:
+  using type = decltype(impl(std::make_index_sequence<size()>{}));
 };
-template <typename S1, typename S2, typename... SS>
-struct seq_join<S1,S2,SS...>
-: seq_join<typename seq_join<S1,S2>::type,SS...> { };
 template <typename... SS>
 using seq_join_t = typename seq_join<SS...>::type;
 
@@ -85,6 +112,36 @@ template <typename... Args> constexpr void fold(Args...) noexcept { };
 template <typename T> struct is_tuple: std::false_type { };
 template <typename... T> struct is_tuple<std::tuple<T...>>: std::true_type { };
 
+// sequence containers, but not strings
+template <typename T, typename = void>
+struct is_container: std::false_type { };
+template <typename T>
+struct is_container<T, void_t<
+  typename T::value_type, decltype(std::declval<T&>().emplace_back())
+>>: std::true_type { };
+
+// containers that can be resized and whose elements are distinct
+// objects, so that they can be written from different threads
+// (not std::vector<bool>)
+template <typename T, typename = void>
+struct is_indexable_container: std::false_type { };
+template <typename T>
+struct is_indexable_container<T, void_t<
+  decltype(std::declval<T&>().resize(0)),
+  std::enable_if_t<std::is_same<
+    decltype(std::declval<T&>()[0]), typename T::value_type&
+  >::value>
+>>: is_container<T> { };
+
+template <typename T, typename = void>
+struct value_type_of { using type = T; };
+template <typename T>
+struct value_type_of<T, std::enable_if_t<is_container<T>::value>> {
+  using type = typename T::value_type;
+};
+template <typename T>
+using value_type_of_t = typename value_type_of<T>::type;
+
 } // end namespace ivanp
 
 #endif
@@ -1,6 +1,16 @@
 #include <iostream>
 #include <cstring>
 #include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <fstream>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "args_parser.hh"
 
@@ -31,9 +41,479 @@ arg_type get_arg_type(const char* arg) noexcept {
   }
 }
 
+void parallel_for_impl(
+  size_t n, unsigned nthreads, void(*f)(void*,size_t), void* ctx
+) {
+  if (!nthreads) nthreads = std::thread::hardware_concurrency();
+  if (nthreads > n/parallel_grain) nthreads = n/parallel_grain;
+  if (nthreads < 2) {
+    for (size_t i=0; i<n; ++i) f(ctx,i);
+    return;
+  }
+
+  struct range {
+    std::mutex m;
+    size_t begin, end;
+  };
+  std::unique_ptr<range[]> ranges(new range[nthreads]);
+  for (unsigned k=0; k<nthreads; ++k) {
+    ranges[k].begin = n* k   /nthreads;
+    ranges[k].end   = n*(k+1)/nthreads;
+  }
+
+  // take next index from own range, or steal from another thread
+  auto next = [&](unsigned k, size_t& i) -> bool {
+    {
+      range& r = ranges[k];
+      std::lock_guard<std::mutex> lock(r.m);
+      if (r.begin < r.end) { i = r.begin++; return true; }
+    }
+    for (unsigned j=1; j<nthreads; ++j) {
+      range& v = ranges[(k+j)%nthreads];
+      size_t b, e;
+      {
+        std::lock_guard<std::mutex> lock(v.m);
+        if (v.begin >= v.end) continue;
+        b = v.end - (v.end - v.begin + 1)/2;
+        e = v.end;
+        v.end = b;
+      }
+      range& r = ranges[k];
+      std::lock_guard<std::mutex> lock(r.m);
+      r.begin = b+1;
+      r.end = e;
+      i = b;
+      return true;
+    }
+    return false;
+  };
+
+  std::atomic<size_t> first_fail(n);
+  std::exception_ptr err;
+  std::mutex err_m;
+
+  auto work = [&](unsigned k){
+    for (size_t i; next(k,i); ) {
+      // indices below the current failure must still be tried,
+      // so that the reported one is the first in argv order
+      if (i > first_fail.load(std::memory_order_relaxed)) continue;
+      try {
+        f(ctx,i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(err_m);
+        if (i < first_fail) {
+          first_fail = i;
+          err = std::current_exception();
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(nthreads-1);
+  for (unsigned k=1; k<nthreads; ++k) threads.emplace_back(work,k);
+  work(0);
+  for (auto& t : threads) t.join();
+
+  if (err) std::rethrow_exception(err);
+}
+
+}
+
+// Command line splitting -------------------------------------------
+
+namespace {
+
+struct char_class {
+  bool special[256] = { }; // whitespace, quotes, backslash
+  bool space[256] = { };
+  constexpr char_class() {
+    for (char c : { ' ', '\t', '\n', '\r', '\v', '\f' })
+      special[(unsigned char)c] = space[(unsigned char)c] = true;
+    for (char c : { '\'', '\"', '\\' })
+      special[(unsigned char)c] = true;
+  }
+};
+constexpr char_class cc;
+
+// first whitespace, quote or backslash in [p,end)
+inline const char* find_special(const char* p, const char* end) noexcept {
+#ifdef __SSE2__
+  const __m128i sp = _mm_set1_epi8(' '), sq = _mm_set1_epi8('\''),
+    dq = _mm_set1_epi8('"'), bs = _mm_set1_epi8('\\'),
+    lo = _mm_set1_epi8('\t'-1), hi = _mm_set1_epi8('\r'+1);
+  for (; end-p >= 16; p += 16) {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i m = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(x,sp), _mm_cmpeq_epi8(x,sq)),
+      _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(x,dq), _mm_cmpeq_epi8(x,bs)),
+        _mm_and_si128(_mm_cmpgt_epi8(x,lo), _mm_cmplt_epi8(x,hi)) ));
+    if (const int mask = _mm_movemask_epi8(m))
+      return p + __builtin_ctz(mask);
+  }
+#endif
+  while (p<end && !cc.special[(unsigned char)*p]) ++p;
+  return p;
+}
+
+// first double quote or backslash in [p,end)
+inline const char* find_dquote(const char* p, const char* end) noexcept {
+#ifdef __SSE2__
+  const __m128i dq = _mm_set1_epi8('"'), bs = _mm_set1_epi8('\\');
+  for (; end-p >= 16; p += 16) {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    if (const int mask = _mm_movemask_epi8(
+      _mm_or_si128(_mm_cmpeq_epi8(x,dq), _mm_cmpeq_epi8(x,bs))
+    )) return p + __builtin_ctz(mask);
+  }
+#endif
+  while (p<end && *p!='"' && *p!='\\') ++p;
+  return p;
+}
+
+}
+
+namespace detail {
+
+// Splits like a POSIX shell, without expansions:
+// whitespace separates words, single quotes are literal,
+// inside double quotes backslash escapes only $ ` " \ and newline
+void command_line::split(const char* p, size_t n) {
+  const char* const end = p + n;
+  // every word is at least as long as its unquoted text,
+  // and is followed by whitespace or the end of the string
+  buf.resize(n+1);
+  char* const out0 = &buf[0];
+  char* out = out0;
+  offsets.clear();
+
+  auto copy = [&](const char* a, const char* b){
+    std::memcpy(out,a,b-a);
+    out += b-a;
+  };
+  auto unterminated = [](char q){
+    return args::error("unterminated "s + q + " in command line");
+  };
+
+  for (;;) {
+    while (p<end && cc.space[(unsigned char)*p]) ++p;
+    if (p==end) break;
+    offsets.push_back(out-out0);
+
+    for (;;) {
+      const char* q = find_special(p,end);
+      copy(p,q);
+      p = q;
+      if (p==end || cc.space[(unsigned char)*p]) break;
+
+      if (*p=='\'') {
+        ++p;
+        q = static_cast<const char*>(std::memchr(p,'\'',end-p));
+        if (!q) throw unterminated('\'');
+        copy(p,q);
+        p = q+1;
+      } else if (*p=='"') {
+        for (++p;;) {
+          q = find_dquote(p,end);
+          copy(p,q);
+          if (q==end) throw unterminated('"');
+          if (*q=='"') { p = q+1; break; }
+          if (q+1==end) throw unterminated('"'); // backslash at the end
+          const char c = q[1];
+          if (c=='$' || c=='`' || c=='"' || c=='\\') *out++ = c;
+          else if (c!='\n') *out++ = '\\', *out++ = c;
+          p = q+2;
+        }
+      } else { // backslash
+        if (++p==end) { *out++ = '\\'; break; } // literal at the end
+        if (*p!='\n') *out++ = *p;
+        ++p;
+      }
+    }
+    *out++ = '\0';
+  }
+
+  ptrs.clear();
+  for (size_t o : offsets) ptrs.push_back(out0+o);
+}
+
+}
+
+// Interning --------------------------------------------------------
+
+namespace detail {
+
+const char* intern_table::store(const char* str, size_t len) {
+  constexpr size_t block_size = 1 << 16;
+  char* p;
+  if (len >= block_size/4) { // large strings get their own block
+    blocks.emplace_back(new char[len+1]);
+    p = blocks.back().get();
+  } else {
+    if (left < len+1) {
+      blocks.emplace_back(new char[block_size]);
+      cur = blocks.back().get();
+      left = block_size;
+    }
+    p = cur;
+    cur += len+1;
+    left -= len+1;
+  }
+  std::memcpy(p,str,len);
+  p[len] = '\0';
+  return p;
+}
+
+void intern_table::grow() {
+  std::vector<entry> old(slots.empty() ? 64 : slots.size()*2);
+  old.swap(slots);
+  const size_t mask = slots.size()-1;
+  for (const entry& e : old) {
+    if (!e.str) continue;
+    size_t i = e.hash & mask;
+    while (slots[i].str) i = (i+1) & mask;
+    slots[i] = e;
+  }
+}
+
+interned intern_table::intern(const char* str) {
+  const size_t len = strlen(str);
+  size_t hash = 14695981039346656037ull; // FNV-1a
+  for (size_t i=0; i<len; ++i)
+    hash = (hash ^ (unsigned char)str[i]) * 1099511628211ull;
+
+  if ((n+1)*2 > slots.size()) grow(); // load factor <= 1/2
+  const size_t mask = slots.size()-1;
+  size_t i = hash & mask;
+  for (; slots[i].str; i = (i+1) & mask) {
+    const entry& e = slots[i];
+    if (e.hash==hash && e.len==len && !std::memcmp(e.str,str,len))
+      return { e.str, e.id };
+  }
+  slots[i] = { hash, store(str,len), len, unsigned(n) };
+  ++n;
+  return { slots[i].str, slots[i].id };
+}
+
+void intern_table::clear() noexcept {
+  slots.clear();
+  n = 0;
+  blocks.clear();
+  cur = nullptr;
+  left = 0;
+}
+
+}
+
+void parser::clear_interned() {
+  strings.clear();
+  for (auto& def : arg_defs) def->forget();
+}
+
+void parser::parse_command_line(const char* str, size_t len) {
+  cmd_line.split(str,len);
+  parse_row(cmd_line.argc(),cmd_line.argv(),true);
+}
+
+// Suggestions ------------------------------------------------------
+
+namespace detail {
+
+void name_table::add(const std::string& name) {
+  names.emplace_back(buf.size(),name.size());
+  buf += name;
+}
+
+std::vector<std::string> name_table::nearest(
+  const char* query, unsigned max_dist, unsigned n
+) const {
+  using word = std::uint64_t;
+  const size_t m = strlen(query);
+  if (m==0 || m>64) return { };
+
+  word peq[256] = { }; // positions of each character in query
+  for (size_t i=0; i<m; ++i) peq[(unsigned char)query[i]] |= word(1) << i;
+  const word last = word(1) << (m-1);
+
+  std::vector<std::pair<unsigned,std::uint32_t>> found; // distance, name
+  for (std::uint32_t k=0; k<names.size(); ++k) {
+    const auto& name = names[k];
+    if ((name.second > m ? name.second-m : m-name.second) > max_dist)
+      continue; // length difference alone is too large
+    // Myers (1999), vertical deltas of the last DP column
+    word pv = ~word(0), mv = 0;
+    unsigned dist = m;
+    const char* c = buf.data() + name.first;
+    for (const char* end = c+name.second; c!=end; ++c) {
+      const word eq = peq[(unsigned char)*c];
+      const word xv = eq | mv;
+      const word xh = (((eq & pv) + pv) ^ pv) | eq;
+      word ph = mv | ~(xh | pv);
+      word mh = pv & xh;
+      if (ph & last) ++dist;
+      else if (mh & last) --dist;
+      ph = (ph << 1) | 1; // first row grows by one per character
+      mh <<= 1;
+      pv = mh | ~(xv | ph);
+      mv = ph & xv;
+      // distance drops by at most one per remaining character
+      if (dist > max_dist + (end-c-1)) break;
+    }
+    if (dist <= max_dist) found.emplace_back(dist,k);
+  }
+
+  std::stable_sort(found.begin(),found.end(),
+    [](const auto& a, const auto& b){ return a.first < b.first; });
+  if (found.size() > n) found.resize(n);
+  std::vector<std::string> out;
+  out.reserve(found.size());
+  for (const auto& f : found)
+    out.emplace_back(buf,names[f.second].first,names[f.second].second);
+  return out;
+}
+
+}
+
+// Only called on error, so the table is built on first use
+// Short names are not suggested: any two single letters are one edit
+// apart, so the distance carries no information
+std::string parser::suggest(const char* arg) const {
+  if (!suggestions) {
+    suggestions.reset(new detail::name_table);
+    for (const auto& name : long_names) suggestions->add(name.first);
+  }
+  const char* s = arg;
+  while (*s=='-') ++s;
+  const unsigned max_dist = (strlen(s)+1)/3;
+  const auto near = suggestions->nearest(arg,max_dist);
+  if (near.empty()) return { };
+  std::string msg = ", did you mean ";
+  for (size_t i=0; i<near.size(); ++i) {
+    if (i) msg += i+1==near.size() ? " or " : ", ";
+    msg += near[i];
+  }
+  return msg + '?';
+}
+
+// Columns ----------------------------------------------------------
+
+namespace detail {
+
+void column::end_row(bool given) {
+  if (multi) row_offsets.push_back(nvalues);
+  else if (!given) { // keep one slot per row
+    if (width) values.resize(values.size()+width);
+    else value_offsets.push_back(values.size());
+    ++nvalues;
+  }
+  if (given) valid.set(rows);
+  ++rows;
+}
+
+void column::rollback() {
+  nvalues = multi ? row_offsets.back() : rows;
+  if (width) values.resize(nvalues*width);
+  else {
+    value_offsets.resize(nvalues+1);
+    values.resize(value_offsets.back());
+  }
+}
+
+void write_columns(const std::string& filename,
+  const std::vector<std::unique_ptr<column>>& cols, std::uint64_t rows
+) {
+  using word = std::uint64_t;
+  const size_t nvalid = (rows+63)/64;
+
+  // layout
+  word pos = (3 + cols.size()*10)*sizeof(word);
+  auto section = [&pos](size_t bytes) -> word {
+    if (!bytes) return 0;
+    const word p = pos;
+    pos += (bytes+7) & ~word(7);
+    return p;
+  };
+  std::vector<word> dir;
+  dir.reserve(cols.size()*10);
+  for (const auto& c : cols) {
+    dir.push_back(word(c->kind) | word(c->width)<<8 | word(c->multi)<<16);
+    dir.push_back(section(c->name.size()));
+    dir.push_back(c->name.size());
+    dir.push_back(section(nvalid*sizeof(word)));
+    dir.push_back(c->multi ? section((rows+1)*sizeof(word)) : 0);
+    dir.push_back(c->width ? 0 : section((c->nvalues+1)*sizeof(word)));
+    dir.push_back(section(c->values.size()));
+    dir.push_back(c->nvalues);
+    dir.push_back(c->values.size());
+    dir.push_back(0);
+  }
+
+  std::ofstream f(filename, std::ios::binary);
+  if (!f) throw args::error("cannot open "+filename);
+  auto write = [&f](const void* p, size_t bytes){
+    if (!bytes) return;
+    f.write(static_cast<const char*>(p),bytes);
+    static const char zeros[8] = { };
+    f.write(zeros,(8-bytes%8)%8);
+  };
+  const word header[] = { rows, cols.size() };
+  f.write("ARGSCOL1",8);
+  f.write(reinterpret_cast<const char*>(header),sizeof(header));
+  write(dir.data(),dir.size()*sizeof(word));
+  for (const auto& c : cols) {
+    write(c->name.data(),c->name.size());
+    std::vector<word> valid(c->valid.words());
+    valid.resize(nvalid);
+    write(valid.data(),nvalid*sizeof(word));
+    if (c->multi)
+      write(c->row_offsets.data(),c->row_offsets.size()*sizeof(word));
+    if (!c->width)
+      write(c->value_offsets.data(),c->value_offsets.size()*sizeof(word));
+    write(c->values.data(),c->values.size());
+  }
+  if (!f) throw args::error("failed writing "+filename);
+}
+
+}
+
+parser& parser::batch(bool on) {
+  cols.clear();
+  rows = 0;
+  for (auto& def : arg_defs) {
+    def->col = nullptr;
+    if (!on) continue;
+    if (auto col = def->make_column()) {
+      def->col = col.get();
+      cols.emplace_back(std::move(col));
+    }
+  }
+  return *this;
+}
+
+void parser::write_columns(const std::string& filename) const {
+  detail::write_columns(filename,cols,rows);
 }
 
 void parser::parse(int argc, char const * const * argv) {
+  parse_row(argc,argv,false);
+}
+
+// In batch mode a failed parse leaves no partial row behind
+void parser::parse_row(int argc, char const * const * argv, bool scratch) {
+  if (cols.empty()) return parse_args(argc,argv,scratch);
+  try {
+    parse_args(argc,argv,scratch);
+  } catch (...) {
+    for (auto& col : cols) col->rollback();
+    throw;
+  }
+  for (auto& def : arg_defs)
+    if (def->col) def->col->end_row(def->count);
+  ++rows;
+}
+
+void parser::parse_args(int argc, char const * const * argv, bool scratch) {
   using namespace ::ivanp::args::detail;
   // for (int i=1; i<argc; ++i) {
   //   for (const auto& m : help_matchers) {
@@ -44,20 +524,49 @@ void parser::parse(int argc, char const * const * argv) {
   //   }
   // }
 
+  if (!frozen) freeze();
+
   arg_def_base *waiting = nullptr;
+  bool need = false; // waiting hasn't received a value yet
   const char* str = nullptr;
   std::string tmp;
+  size_t slot = 0; // next positional slot
+
+  seen.reset();
+  over.reset();
+  for (auto& def : arg_defs) def->count = 0;
+  for (auto* def : deferred) def->discard();
+  auto value = [this,scratch](arg_def_base* def, const char* arg){
+    if (interning || (scratch && pointer_defs.test(def->index)))
+      def->parse_interned(strings.intern(arg));
+    else def->parse(arg);
+  };
+  auto parsed = [this](arg_def_base* def){
+    if (def->count > def->max()) over.set(def->index);
+  };
+  auto matched = [&](arg_def_base* def){
+    seen.set(def->index);
+    if (str) value(def,str), str = nullptr; // call parser & reset
+    else if (def->is_switch()) { }
+    else { waiting = def, need = true; return; }
+    parsed(def);
+  };
+  auto try_match = [&](const auto& m, const char* arg){
+    if (!(*m.first)(arg)) return false;
+    matched(m.second);
+    return true;
+  };
 
   for (int i=1; i<argc; ++i) {
     const char* arg = argv[i];
 
     const auto arg_type = get_arg_type(arg);
-    cout << arg << ' ' << arg_type << endl;
 
     // ==============================================================
     if (arg_type!=context_arg) {
-      if (waiting && waiting->need)
+      if (waiting && need)
         throw args::error(waiting->name() + " without value");
+      waiting = nullptr;
     }
 
     switch (arg_type) {
@@ -87,31 +596,202 @@ void parser::parse(int argc, char const * const * argv) {
 
     // ==============================================================
 
-    if (arg_type!=context_arg || !waiting) {
-      for (auto& m : matchers[arg_type]) {
-        auto& def = m.second;
-        const auto name = def->name();
-        cout << "trying: " << name << endl;
-        if ((*m.first)(arg)) {
-          cout << arg << " matched: " << name << endl;
-          if (def->count==0) throw error("excessive arg " + name);
-          if (str) def->parse(str), str = nullptr; // call parser & reset
-          else if (def->is_switch()) { }
-          else waiting = def;
+    if (arg_type==context_arg && !waiting) {
+      // bare arguments go to positional slots by index
+      arg_def_base *def = slot < positional.size()
+        ? positional[slot++] : variadic;
+      if (def) {
+        seen.set(def->index);
+        value(def,arg), str = nullptr;
+        parsed(def);
+        goto cont;
+      }
+    }
+
+    if (arg_type==long_arg) {
+      // long options are looked up by name or unambiguous prefix
+      if (arg_def_base *def = find_long(arg)) {
+        matched(def);
+        goto cont;
+      }
+    } else if (arg_type==short_arg) {
+      for (auto& m : matchers[short_arg])
+        if (try_match(m,arg)) goto cont;
+    } else if (!waiting) {
+      for (unsigned id : context_order)
+        if (try_match(matchers[context_arg][id],arg)) {
+          ++context_hits[id];
           goto cont;
         }
-      }
     }
 
-    if (waiting && waiting->count) {
-      waiting->parse(arg);
-      if (!waiting->count) waiting = nullptr;
+    if (waiting) {
+      value(waiting,arg);
+      need = false;
+      parsed(waiting);
+      if (waiting->count >= waiting->max()) waiting = nullptr;
       goto cont;
     }
 
-    throw args::error("unexpected option "s + arg);
+    throw args::error("unexpected option "s + arg +
+      (arg_type!=context_arg ? suggest(arg) : std::string()));
     cont: ;
   }
+  if (waiting && need)
+    throw args::error(waiting->name() + " without value");
+
+  if (adaptive_order) reorder_context();
+
+  validate();
+  for (auto* def : deferred) def->flush();
+}
+
+void parser::freeze() {
+  positional.clear();
+  variadic = nullptr;
+  for (auto* def : pos_defs) {
+    if (variadic) throw std::invalid_argument(
+      "positional argument " + variadic->name() + " with multi() "
+      "must be the last positional argument");
+    if (def->max() > 1) variadic = def;
+    else positional.push_back(def);
+  }
+
+  // keep learned order, append matchers added since
+  const unsigned n = matchers[detail::context_arg].size();
+  for (unsigned i=context_order.size(); i<n; ++i) context_order.push_back(i);
+  context_hits.resize(n);
+
+  suggestions.reset();
+
+  std::sort(long_names.begin(),long_names.end(),
+    [](const auto& a, const auto& b){ return a.first < b.first; });
+
+  frozen = true;
+}
+
+// Binary search for the first name >= arg, then walk the k names that
+// start with arg. An exact match wins, otherwise the prefix must
+// belong to a single definition.
+detail::arg_def_base* parser::find_long(const char* arg) const {
+  const size_t len = strlen(arg);
+  auto it = std::lower_bound(long_names.begin(),long_names.end(),arg,
+    [](const auto& a, const char* b){ return strcmp(a.first.c_str(),b) < 0; });
+
+  if (it!=long_names.end() && it->first==arg) return it->second;
+  if (len<=2) return nullptr; // a prefix needs at least one character
+
+  detail::arg_def_base *def = nullptr;
+  bool ambiguous = false;
+  const auto first = it, end = long_names.end();
+  for (; it!=end && !it->first.compare(0,len,arg); ++it) {
+    if (!def) def = it->second;
+    else if (def!=it->second) ambiguous = true;
+  }
+  if (!ambiguous) return def;
+
+  std::string msg = "ambiguous option "s + arg + ": ";
+  for (auto c=first; c!=it; ++c) {
+    if (c!=first) msg += ", ";
+    msg += c->first;
+  }
+  throw args::error(msg);
+}
+
+bool parser::is_ordered(unsigned m) const {
+  return ordered_defs.test(matchers[detail::context_arg][m].second->index);
+}
+
+// Stable sort runs of matchers between ordered() ones by hits
+void parser::reorder_context() {
+  auto first = context_order.begin();
+  const auto end = context_order.end();
+  while (first!=end) {
+    if (is_ordered(*first)) { ++first; continue; }
+    const auto last = std::find_if(first,end,
+      [this](unsigned m){ return is_ordered(m); });
+    std::stable_sort(first,last,[this](unsigned a, unsigned b){
+      return context_hits[a] > context_hits[b];
+    });
+    first = last;
+  }
+}
+
+std::vector<unsigned> parser::matcher_order() {
+  if (!frozen) freeze();
+  return context_order;
+}
+
+parser& parser::matcher_order(std::vector<unsigned> order) {
+  if (!frozen) freeze();
+  const unsigned n = context_order.size();
+  // segment of each declared position, delimited by ordered() matchers
+  std::vector<unsigned> seg(n);
+  for (unsigned i=0, k=0; i<n; ++i) {
+    if (is_ordered(i)) ++k;
+    seg[i] = k;
+  }
+  std::vector<bool> used(n);
+  bool ok = order.size()==n;
+  for (unsigned i=0; ok && i<n; ++i) {
+    const unsigned m = order[i];
+    ok = m<n && !used[m] && seg[m]==seg[i] && (!is_ordered(i) || m==i);
+    if (ok) used[m] = true;
+  }
+  if (!ok) throw std::invalid_argument(
+    "matcher order is not a valid permutation of context matchers");
+  context_order = std::move(order);
+  return *this;
+}
+
+detail::arg_def_base* parser::find(const char* opt) const {
+  for (const auto& m : matchers[detail::get_arg_type(opt)])
+    if ((*m.first)(opt)) return m.second;
+  throw std::invalid_argument("undefined program argument "s + opt);
+}
+
+parser& parser::exclusive(std::initializer_list<const char*> opts) {
+  detail::bitmask group;
+  for (const char* opt : opts) group.set(find(opt)->index);
+  exclusive_groups.emplace_back(std::move(group));
+  return *this;
+}
+
+parser& parser::depends(
+  const char* opt, std::initializer_list<const char*> deps
+) {
+  detail::bitmask mask;
+  for (const char* dep : deps) mask.set(find(dep)->index);
+  dependencies.emplace_back(find(opt)->index,std::move(mask));
+  return *this;
+}
+
+// All checks are word operations on the masks, done in place;
+// masks and names are only built for the checks that failed
+void parser::validate() const {
+  std::string msg;
+  auto names = [this](const detail::bitmask& m){
+    std::string s;
+    m.for_each([&](size_t i){
+      if (!s.empty()) s += ", ";
+      s += arg_defs[i]->name();
+    });
+    return s;
+  };
+
+  if (required.any_but(seen))
+    msg += "\nmissing required: " + names(required - seen);
+  if (over.any())
+    msg += "\ntoo many values: " + names(over);
+  for (const auto& group : exclusive_groups)
+    if (group.count_and(seen) > 1)
+      msg += "\nmutually exclusive: " + names(group & seen);
+  for (const auto& dep : dependencies)
+    if (seen.test(dep.first) && dep.second.any_but(seen))
+      msg += "\n" + arg_defs[dep.first]->name() + " requires: "
+           + names(dep.second - seen);
+
+  if (!msg.empty()) throw args::error(msg.substr(1));
 }
 
 // FIXME
@@ -0,0 +1,12 @@
+#include <iostream>
+
+#include "args_parser.hh"
+
+namespace ivanp { namespace args {
+
+#define ARGS_PARSER_INSTANCE(...) \
+  template class detail::arg_def<__VA_ARGS__>;
+ARGS_PARSER_INSTANCES(ARGS_PARSER_INSTANCE)
+#undef ARGS_PARSER_INSTANCE
+
+}} // end namespace ivanp
@@ -0,0 +1,550 @@
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <cstdio>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+#define ARGS_PARSER_BOOST_LEXICAL_CAST
+#include "args_parser.hh"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+using namespace ivanp::args;
+
+static unsigned failed = 0;
+
+#define CHECK(expr) \
+  if (!(expr)) { \
+    ++failed; \
+    cerr <<"\033[31m"<< __FILE__ <<':'<< __LINE__ \
+         <<": CHECK( " #expr " ) failed\033[0m"<< endl; \
+  }
+
+// message of the exception of type E thrown by f, or "" if none
+template <typename E = error, typename F>
+std::string error_of(F&& f) {
+  try { f(); }
+  catch (const E& e) { return e.what(); }
+  return { };
+}
+
+void parse(parser& p, std::vector<const char*> args) {
+  args.insert(args.begin(),"prog");
+  p.parse(args.size(),args.data());
+}
+
+// par() ------------------------------------------------------------
+
+void test_par() {
+  std::vector<double> v { 1, 2 };
+  parser p;
+  p(&v,"--vals","",multi(),par(4));
+
+  std::vector<const char*> args { "--vals" };
+  std::vector<std::string> vals;
+  for (int i=0; i<100000; ++i) vals.push_back(std::to_string(i));
+  vals[70000] = "bad";
+  for (const auto& s : vals) args.push_back(s.c_str());
+
+  // a failed conversion leaves the recepient as it was
+  CHECK( error_of([&]{ parse(p,args); })
+    == "\"bad\" cannot be interpreted as double" )
+  CHECK( v.size()==2 )
+
+  vals[70000] = "70000";
+  parse(p,args);
+  CHECK( v.size()==100002 )
+  CHECK( v[2]==0 && v[70002]==70000 && v.back()==99999 )
+}
+
+// short par() loops run on the calling thread
+void test_par_grain() {
+  const auto id = std::this_thread::get_id();
+  std::atomic<bool> slept { false };
+  std::vector<int> v;
+  parser p;
+  p(&v,"-v","",multi(),par(4),
+    [id,&slept](const char*, int& x){
+      x = std::this_thread::get_id()==id;
+      // give other threads, if any, time to take their share
+      if (x && !slept.exchange(true))
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    });
+
+  std::vector<const char*> args { "-v" };
+  args.resize(detail::parallel_grain*2,"x");
+  parse(p,args); // 2*grain-1 values, too few for two threads
+  CHECK( v.size()==args.size()-1 )
+  CHECK( std::count(v.begin(),v.end(),1) == int(v.size()) )
+}
+
+void test_elements() {
+  std::vector<int> v;
+  parser p;
+  p(&v,"-v","v",multi());
+
+  // a failed conversion leaves no element behind
+  CHECK( error_of([&]{ parse(p,{"-v","1","x"}); })
+    == "\"x\" cannot be interpreted as int" )
+  CHECK( v == std::vector<int>({1}) )
+
+  p.intern(); // memoized path
+  CHECK( error_of([&]{ parse(p,{"-v","2","x"}); })
+    == "\"x\" cannot be interpreted as int" )
+  CHECK( v == std::vector<int>({1,2}) )
+}
+
+// memoized conversions ---------------------------------------------
+
+void test_memo() {
+  unsigned calls = 0;
+  auto count = [&calls](const char* arg, int& x){
+    ++calls;
+    x = std::atoi(arg);
+  };
+  int i = 0, j = 0;
+  std::vector<int> v;
+  parser p;
+  p (&i,"-i","i",count,pure())
+    (&v,"-v","v",multi(),count,pure())
+    .intern();
+
+  // a hit returns the stored value
+  parse(p,{"-i","5"});
+  parse(p,{"-i","6"});
+  i = 0;
+  parse(p,{"-i","5"});
+  CHECK( i==5 && calls==2 )
+
+  // also into container elements; memos are per definition
+  parse(p,{"-v","5","-v","7","-v","5"});
+  CHECK( v == std::vector<int>({5,7,5}) && calls==4 )
+  parse(p,{"-v","7"});
+  CHECK( v == std::vector<int>({5,7,5,7}) && calls==4 )
+
+  // clear_interned() drops the memo
+  p.clear_interned();
+  parse(p,{"-i","5"});
+  CHECK( i==5 && calls==5 )
+
+  // custom parsers without pure() are not memoized
+  parser q;
+  q(&j,"-j","j",count).intern();
+  parse(q,{"-j","5"});
+  parse(q,{"-j","5"});
+  CHECK( j==5 && calls==7 )
+}
+
+// validation -------------------------------------------------------
+
+void test_validate() {
+  int a, b, c;
+  std::vector<int> m;
+  bool x, y;
+  parser p;
+  p (&a,"-a","A",req())
+    (&b,"-b","B",req())
+    (&c,"-c","C")
+    (&m,"-m","M",multi(2))
+    (&x,"-x","X")
+    (&y,"-y","Y")
+    .exclusive({"-x","-y"})
+    .depends("-c",{"-a","-b"});
+
+  // counts are per parse
+  CHECK( error_of([&]{ parse(p,{"-a1","-b2","-m1","-m2"}); }).empty() )
+  CHECK( error_of([&]{ parse(p,{"-a1","-b2","-m1","-m2"}); }).empty() )
+
+  CHECK( error_of([&]{ parse(p,{}); }) == "missing required: A, B" )
+  CHECK( error_of([&]{ parse(p,{"-a1","-b2","-m1","-m2","-m3"}); })
+    == "too many values: M" )
+  CHECK( error_of([&]{ parse(p,{"-a1","-b2","-x","-x"}); })
+    == "too many values: X" )
+  CHECK( error_of([&]{ parse(p,{"-a1","-b2","-x","-y"}); })
+    == "mutually exclusive: X, Y" )
+  CHECK( error_of([&]{ parse(p,{"-a1","-b2","-c3"}); }).empty() )
+  CHECK( error_of([&]{ parse(p,{"-b2","-c3","-x","-y"}); })
+    == "missing required: A\n"
+       "mutually exclusive: X, Y\n"
+       "C requires: A" )
+}
+
+// positional -------------------------------------------------------
+
+void test_positional() {
+  std::string a, tail;
+  int b = 0;
+  std::vector<double> rest;
+  parser p;
+  p (&a,"-a","a",pos())
+    (&b,"-b","b",pos())
+    (&rest,"-r","r",pos(),multi());
+
+  // bare arguments fill the slots in order, the last one takes the rest
+  parse(p,{"x","2","1.5","2.5"});
+  CHECK( a=="x" && b==2 && rest==std::vector<double>({1.5,2.5}) )
+  rest.clear();
+  parse(p,{"y","-b","3"});
+  CHECK( a=="y" && b==3 && rest.empty() )
+  CHECK( error_of([&]{ parse(p,{"z","5"}); }).empty() )
+  CHECK( error_of([&]{ parse(p,{"z","x"}); })
+    == "\"x\" cannot be interpreted as int" )
+
+  // context matchers are tried once the slots run out
+  parser q;
+  q (&a,"-a","a",pos())
+    (&tail,[](const char* arg){ return arg[0]=='t'; },"tail");
+  parse(q,{"x","tail"});
+  CHECK( a=="x" && tail=="tail" )
+  CHECK( error_of([&]{ parse(q,{"x","y"}); }) == "unexpected option y" )
+
+  // a variadic slot has to be the last one
+  parser r;
+  r (&rest,"-r","r",pos(),multi())
+    (&a,"-a","a",pos());
+  CHECK( error_of<std::invalid_argument>([&]{ parse(r,{"1"}); })
+    == "positional argument r with multi() "
+       "must be the last positional argument" )
+}
+
+// long names -------------------------------------------------------
+
+void test_long_names() {
+  bool verbose = false;
+  double value = 0;
+  parser p1;
+  p1(&verbose,"--verbose","verbose");
+
+  CHECK( error_of([&]{ parse(p1,{"--"}); }) == "unexpected option --" )
+  CHECK( error_of([&]{ parse(p1,{"--=x"}); }) == "unexpected option --" )
+  CHECK( !verbose )
+  parse(p1,{"--verb"});
+  CHECK( verbose )
+
+  parser p2;
+  p2(&verbose,"--verbose","verbose")
+    (&value,"--value","value");
+
+  CHECK( error_of([&]{ parse(p2,{"--"}); }) == "unexpected option --" )
+  CHECK( error_of([&]{ parse(p2,{"--v"}); })
+    == "ambiguous option --v: --value, --verbose" )
+  parse(p2,{"--val=2.5"});
+  CHECK( value==2.5 )
+
+  // a prefix of several names of one definition is not ambiguous
+  int level = 0;
+  parser p3;
+  p3(&level,{"--verbose","--verbosity"},"level");
+  parse(p3,{"--verb","2"});
+  CHECK( level==2 )
+}
+
+// adaptive matcher order -------------------------------------------
+
+void test_adaptive() {
+  using strs = std::vector<std::string>;
+  using order = std::vector<unsigned>;
+  strs a, b, c, d;
+  auto define = [&](parser& p){
+    p (&a,[](const char* s){ return s[0]=='a'; },"a",multi())
+      (&b,[](const char* s){ return s[0]=='b'; },"b",multi())
+      (&c,[](const char* s){ return s[0]=='c'; },"c",multi(),ordered())
+      (&d,[](const char* s){ return s[0]=='d'; },"d",multi());
+  };
+  parser p;
+  define(p);
+  p.adaptive();
+  CHECK( p.matcher_order() == order({0,1,2,3}) )
+
+  // sorted by hits within the run before the ordered() matcher
+  parse(p,{"b1","b2","a1","c1"});
+  CHECK( p.matcher_order() == order({1,0,2,3}) )
+  CHECK( a==strs({"a1"}) && b==strs({"b1","b2"}) && c==strs({"c1"}) )
+
+  // nothing moves across the ordered() matcher
+  parse(p,{"d1","d2","d3","d4","d5"});
+  CHECK( p.matcher_order() == order({1,0,2,3}) )
+  CHECK( d.size()==5 )
+
+  // hits accumulate over parses
+  parse(p,{"a2","a3"});
+  CHECK( p.matcher_order() == order({0,1,2,3}) )
+  parse(p,{"b3"});
+  CHECK( p.matcher_order() == order({0,1,2,3}) ) // a 3, b 3: stable
+  parse(p,{"b4"});
+  CHECK( p.matcher_order() == order({1,0,2,3}) )
+
+  // export and reload; without adaptive() the order stays fixed
+  const auto saved = p.matcher_order();
+  parser q;
+  define(q);
+  q.matcher_order(saved);
+  CHECK( q.matcher_order() == saved )
+  parse(q,{"a4","a5","a6"});
+  CHECK( q.matcher_order() == saved )
+
+  // only permutations within runs between ordered() matchers
+  auto invalid = [&](order o){
+    return error_of<std::invalid_argument>([&]{ q.matcher_order(o); })
+      == "matcher order is not a valid permutation of context matchers";
+  };
+  CHECK( invalid({0,1,2}) )       // too short
+  CHECK( invalid({0,1,2,3,3}) )   // too long
+  CHECK( invalid({0,0,2,3}) )     // repeated
+  CHECK( invalid({0,1,2,4}) )     // out of range
+  CHECK( invalid({0,1,3,2}) )     // ordered() moved
+  CHECK( invalid({3,1,2,0}) )     // across ordered()
+  CHECK( q.matcher_order() == saved )
+  CHECK( error_of<std::invalid_argument>([&]{ q.matcher_order({0,1,2,3}); })
+    .empty() )
+}
+
+// command line -----------------------------------------------------
+
+std::vector<std::string> words(const std::string& str) {
+  detail::command_line cmd;
+  cmd.split(str.data(),str.size());
+  return { cmd.argv(), cmd.argv()+cmd.argc() };
+}
+using strs = std::vector<std::string>;
+
+void test_command_line() {
+  // quotes at the end of the line
+  CHECK( words("prog --name \"foo bar\"") == strs({"prog","--name","foo bar"}) )
+  CHECK( words("prog --name 'foo bar'") == strs({"prog","--name","foo bar"}) )
+  CHECK( words("prog \"a\"\"b\"") == strs({"prog","ab"}) )
+
+  // empty quoted words
+  CHECK( words("prog --name \"\"") == strs({"prog","--name",""}) )
+  CHECK( words("a '' b \"\"") == strs({"a","","b",""}) )
+
+  // escapes
+  CHECK( words(R"("a\"b\\c\$d\`e\x")") == strs({R"(a"b\c$d`e\x)"}) )
+  CHECK( words("\"a\\\nb\"") == strs({"ab"}) )
+  CHECK( words(R"('a\"b' a\ b a\'b)") == strs({R"(a\"b)","a b","a'b"}) )
+  CHECK( words(" \t a\n\nb \r") == strs({"a","b"}) )
+
+  // trailing backslash
+  CHECK( words("prog foo\\") == strs({"prog","foo\\"}) )
+  CHECK( words("\\") == strs({"\\"}) )
+  CHECK( error_of([]{ words("prog \"foo\\"); })
+    == "unterminated \" in command line" )
+
+  CHECK( error_of([]{ words("prog \"foo"); })
+    == "unterminated \" in command line" )
+  CHECK( error_of([]{ words("prog 'foo"); })
+    == "unterminated ' in command line" )
+
+  // words longer than 16 bytes, with special characters at and around
+  // the block boundaries
+  for (unsigned n=0; n<40; ++n) {
+    const std::string a(n,'a'), b(40-n,'b');
+    CHECK( words(a+"\"x y\""+b) == strs({a+"x y"+b}) )
+    CHECK( words(a+"'x y'"+b) == strs({a+"x y"+b}) )
+    CHECK( words("\""+a+"\\\""+b+"\"") == strs({a+"\""+b}) )
+    CHECK( words(a+"\\ "+b) == strs({a+" "+b}) )
+    if (n) CHECK( words(a+"\t"+b) == strs({a,b}) )
+  }
+
+  std::string name;
+  parser p;
+  p(&name,"--name","name");
+  p.parse_command_line("prog --name \"foo bar\"");
+  CHECK( name=="foo bar" )
+  p.parse_command_line("prog --name \"\"");
+  CHECK( name=="" )
+
+  // const char* values outlive the words of the command line
+  const char *a = nullptr, *b = nullptr;
+  parser q;
+  q (&a,"-a","a")
+    (&b,"-b","b");
+  q.parse_command_line("prog -a abc");
+  q.parse_command_line("prog -b xyz");
+  CHECK( a && !strcmp(a,"abc") )
+  q.parse_command_line("prog -b "+std::string(1000,'x'));
+  CHECK( a && !strcmp(a,"abc") )
+  CHECK( b && strlen(b)==1000 )
+}
+
+// columns ----------------------------------------------------------
+
+void test_columns() {
+  int n = 0;
+  std::string s;
+  std::vector<double> v;
+  bool f = false;
+  parser p;
+  p (&n,"-n","n")
+    (&s,"-s","s")
+    (&v,"-v","v",multi())
+    (&f,"-f","f")
+    .batch();
+
+  parse(p,{"-n","1","-s","ab","-v","1.5","-v","2.5","-f"});
+  parse(p,{"-s","xyz"});
+  CHECK( error_of([&]{ parse(p,{"-n","3","-v","9","-s","q","--bogus"}); })
+    == "unexpected option --bogus" )
+  parse(p,{"-n","4","-v","3.5"});
+  CHECK( n==0 && s.empty() && v.empty() && !f ) // recepients not touched
+
+  const char* filename = "test/check_columns.tmp";
+  auto read = [filename]{
+    std::ifstream in(filename, std::ios::binary);
+    std::string file { std::istreambuf_iterator<char>(in), { } };
+    in.close();
+    std::remove(filename);
+    return file;
+  };
+  p.write_columns(filename);
+  std::string file = read();
+
+  using word = std::uint64_t;
+  auto at = [&](word pos) -> const char* {
+    return pos < file.size() ? file.data()+pos : nullptr;
+  };
+  auto w = [&](word pos){
+    word x = 0;
+    if (pos+8 <= file.size()) std::memcpy(&x,file.data()+pos,8);
+    return x;
+  };
+  auto words = [&](word pos, word n){
+    std::vector<word> x(n);
+    for (word i=0; i<n; ++i) x[i] = w(pos+i*8);
+    return x;
+  };
+  auto values = [&](auto x, word pos, word n){
+    std::vector<decltype(x)> vals(n);
+    if (n) std::memcpy(vals.data(),at(pos),n*sizeof(x));
+    return vals;
+  };
+
+  CHECK( file.size()%8 == 0 )
+  CHECK( file.compare(0,8,"ARGSCOL1")==0 )
+  CHECK( w(8)==3 && w(16)==4 ) // rows, columns
+
+  // every section is aligned and inside the file
+  for (word c=0; c<4; ++c)
+    for (word k : {1,3,4,5,6}) {
+      const word pos = w(24+(c*10+k)*8);
+      CHECK( pos%8==0 && pos<file.size() )
+    }
+
+  auto dir = [&](word c, word k){ return w(24+(c*10+k)*8); };
+  auto name = [&](word c){ return std::string(at(dir(c,1)),dir(c,2)); };
+
+  // n: int, one slot per row
+  CHECK( name(0)=="n" )
+  CHECK( dir(0,0) == ('i' | 4<<8) )
+  CHECK( w(dir(0,3)) == 0b101 )
+  CHECK( dir(0,4)==0 && dir(0,5)==0 )
+  CHECK( dir(0,7)==3 && dir(0,8)==12 )
+  CHECK( values(int(),dir(0,6),3) == std::vector<int>({1,0,4}) )
+
+  // s: string, empty in rows where not given
+  CHECK( name(1)=="s" )
+  CHECK( dir(1,0) == 's' )
+  CHECK( w(dir(1,3)) == 0b011 )
+  CHECK( dir(1,4)==0 )
+  CHECK( words(dir(1,5),4) == std::vector<word>({0,2,5,5}) )
+  CHECK( dir(1,7)==3 && dir(1,8)==5 )
+  CHECK( std::string(at(dir(1,6)),5) == "abxyz" )
+
+  // v: multi double, delimited by row offsets
+  CHECK( name(2)=="v" )
+  CHECK( dir(2,0) == ('f' | 8<<8 | 1<<16) )
+  CHECK( w(dir(2,3)) == 0b101 )
+  CHECK( words(dir(2,4),4) == std::vector<word>({0,2,2,3}) )
+  CHECK( dir(2,5)==0 )
+  CHECK( dir(2,7)==3 && dir(2,8)==24 )
+  CHECK( values(double(),dir(2,6),3) == std::vector<double>({1.5,2.5,3.5}) )
+
+  // f: bool switch
+  CHECK( name(3)=="f" )
+  CHECK( dir(3,0) == ('b' | 1<<8) )
+  CHECK( w(dir(3,3)) == 0b001 )
+  CHECK( dir(3,7)==3 && dir(3,8)==3 )
+  CHECK( std::string(at(dir(3,6)),3) == std::string("\1\0\0",3) )
+
+  // container switch: its elements go to the column, rows stay aligned
+  std::vector<double> sw;
+  int k = 0;
+  parser q;
+  q (&sw,"-w","w",switch_init(1.5,2.5))
+    (&k,"-k","k")
+    .batch();
+  parse(q,{"-w","-k","1"});
+  parse(q,{"-k","2"});
+  parse(q,{"-w"});
+  CHECK( sw.empty() && k==0 )
+
+  q.write_columns(filename);
+  file = read();
+  CHECK( w(8)==3 && w(16)==2 )
+  CHECK( dir(0,0) == ('f' | 8<<8 | 1<<16) )
+  CHECK( w(dir(0,3)) == 0b101 )
+  CHECK( words(dir(0,4),4) == std::vector<word>({0,2,2,4}) )
+  CHECK( values(double(),dir(0,6),4)
+    == std::vector<double>({1.5,2.5,1.5,2.5}) )
+  CHECK( w(dir(1,3)) == 0b011 )
+  CHECK( values(int(),dir(1,6),3) == std::vector<int>({1,2,0}) )
+}
+
+// suggestions ------------------------------------------------------
+
+void test_suggest() {
+  bool b;
+  parser p;
+  p (&b,"--color","")
+    (&b,"--output","")
+    (&b,"--value","")
+    (&b,"--valve","")
+    (&b,{"-n","--number"},"");
+
+  auto msg = [&](const char* arg){ return error_of([&]{ parse(p,{arg}); }); };
+
+  CHECK( msg("--colr") == "unexpected option --colr, did you mean --color?" )
+  CHECK( msg("--outptu") == "unexpected option --outptu, did you mean --output?" )
+  CHECK( msg("-output") == "unexpected option -output, did you mean --output?" )
+  CHECK( msg("--valxe")
+    == "unexpected option --valxe, did you mean --value or --valve?" )
+  CHECK( msg("--vlaue") == "unexpected option --vlaue, did you mean --value?" )
+
+  // at most (n+1)/3 edits, for n characters after the dashes
+  CHECK( msg("--clr") == "unexpected option --clr" )           // 2 > 1
+  CHECK( msg("--cloor") == "unexpected option --cloor, did you mean --color?" )
+  CHECK( msg("--xutpux") == "unexpected option --xutpux, did you mean --output?" )
+  CHECK( msg("--xutpxx") == "unexpected option --xutpxx" )     // 3 > 2
+
+  // no suggestions for short options or bare arguments
+  CHECK( msg("-x") == "unexpected option -x" )
+  CHECK( msg("-m") == "unexpected option -m" )
+  CHECK( msg("colr") == "unexpected option colr" )
+}
+
+// ------------------------------------------------------------------
+
+int main() {
+  test_par();
+  test_par_grain();
+  test_elements();
+  test_memo();
+  test_validate();
+  test_positional();
+  test_long_names();
+  test_adaptive();
+  test_command_line();
+  test_columns();
+  test_suggest();
+
+  if (failed) {
+    cerr <<"\033[31m"<< failed <<" checks failed\033[0m"<< endl;
+    return 1;
+  }
+  cout <<"\033[32mall checks passed\033[0m"<< endl;
+}
@@ -0,0 +1,84 @@
+// Throughput of parse_command_line() on logged command lines
+// Reports MB/s for splitting alone, for parsing into std::string
+// recepients, and for parsing with lexical_cast conversions,
+// without and with interning of values repeated across lines
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+
+#define ARGS_PARSER_BOOST_LEXICAL_CAST
+#include "args_parser.hh"
+
+using std::cout;
+using std::endl;
+using namespace ivanp::args;
+
+template <typename F>
+void bench(const char* name, const std::vector<std::string>& lines, F&& f) {
+  size_t bytes = 0;
+  for (const auto& line : lines) bytes += line.size();
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto& line : lines) f(line);
+  const std::chrono::duration<double> t =
+    std::chrono::steady_clock::now() - start;
+  cout << std::left << std::setw(24) << name << std::right
+       << std::setw(8) << std::fixed << std::setprecision(1)
+       << bytes/t.count()*1e-6 << " MB/s"
+       << std::setw(10) << lines.size()/t.count()*1e-3 << " klines/s"
+       << endl;
+}
+
+int main(int argc, char* argv[]) {
+  const unsigned n = argc>1 ? std::atoi(argv[1]) : 200000;
+
+  auto line = [](unsigned i, unsigned j) {
+    return "/usr/local/bin/prog --name \"run " + std::to_string(i) +
+      " of the nightly batch\" --count " + std::to_string(j) +
+      " --ratio " + std::to_string(i*0.001) +
+      " --tag 'x y z' --verbose input_" + std::to_string(i) + ".dat";
+  };
+  std::vector<std::string> lines, repeated;
+  lines.reserve(n);
+  repeated.reserve(n);
+  for (unsigned i=0; i<n; ++i) {
+    lines.push_back(line(i,i%1000));
+    repeated.push_back(line(i%1000,i%1000));
+  }
+
+  detail::command_line cmd;
+  bench("split",lines,[&](const std::string& line){
+    cmd.split(line.data(),line.size());
+  });
+
+  {
+    std::string name, count, ratio, tag, input;
+    bool verbose;
+    parser p;
+    p (&name,"--name","name") (&count,"--count","count")
+      (&ratio,"--ratio","ratio") (&tag,"--tag","tag")
+      (&verbose,"--verbose","verbose") (&input,"input","input",pos());
+    bench("parse, strings",lines,[&](const std::string& line){
+      p.parse_command_line(line);
+    });
+  }
+
+  {
+    std::string name, tag, input;
+    int count;
+    double ratio;
+    bool verbose;
+    parser p;
+    p (&name,"--name","name") (&count,"--count","count")
+      (&ratio,"--ratio","ratio") (&tag,"--tag","tag")
+      (&verbose,"--verbose","verbose") (&input,"input","input",pos());
+    auto parse = [&](const std::string& line){
+      p.parse_command_line(line);
+    };
+    bench("parse, conversions",lines,parse);
+    bench("parse, 1000 distinct",repeated,parse);
+    p.intern();
+    bench("parse, interned",repeated,parse);
+  }
+}
@@ -0,0 +1,42 @@
+#!/bin/bash
+# Compile-time benchmark for explicitly instantiated argument definitions
+# Builds N copies of test/test.cc (default 40) twice:
+#   header-only, and with ARGS_PARSER_EXTERN_TEMPLATES against libargs
+# and reports build time, arg_def instantiations emitted per object,
+# and .text size of the objects and the linked binary
+
+set -e
+cd "$(dirname "$0")/.."
+
+N=${1:-40}
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++14 -O2 -Iinclude -pthread}
+# as LIBFLAGS in Makefile
+LIBFLAGS="$CXXFLAGS -ffunction-sections -fdata-sections -DARGS_PARSER_BOOST_LEXICAL_CAST"
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+$CXX $LIBFLAGS -c src/args_parser.cc -o $dir/args_parser.o
+$CXX $LIBFLAGS -c src/instances.cc -o $dir/instances.o
+
+text() { size -A "$@" | awk '$1~/^\.text/{n+=$2} END{print n}'; }
+
+run() {
+  local name=$1; shift
+  local start=$(date +%s.%N)
+  for i in $(seq $N); do
+    $CXX $CXXFLAGS "$@" -c test/test.cc -o $dir/$name$i.o
+  done
+  local end=$(date +%s.%N)
+  $CXX $CXXFLAGS -Wl,--gc-sections $dir/${name}1.o $dir/args_parser.o \
+    $([ $name = extern ] && echo $dir/instances.o) -o $dir/$name
+  printf "%-12s %8.2fs %8d %10d %10d\n" $name \
+    $(awk "BEGIN{print $end - $start}") \
+    $(nm -C --defined-only $dir/${name}1.o | grep -c 'arg_def<' || true) \
+    $(text $dir/${name}1.o) $(text $dir/$name)
+}
+
+printf "%d translation units\n" $N
+printf "%-12s %9s %8s %10s %10s\n" "" "build" "arg_def" ".text/TU" ".text/bin"
+run header
+run extern -DARGS_PARSER_EXTERN_TEMPLATES
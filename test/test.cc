@@ -15,6 +15,7 @@ int main(int argc, char* argv[]) {
   int i;
   std::string s;
   bool b;
+  std::vector<double> v;
 
   try {
     using namespace ivanp::args;
@@ -27,6 +28,8 @@ int main(int argc, char* argv[]) {
       (&s,std::forward_as_tuple(
             's', [](const char* arg){ return arg[0]=='t'; }),
           "starts with \'t\'")
+      (&v,"--vals","Doubles converted in parallel",multi(),par())
+      .exclusive({"--int","--count"})
       // (&c,".*\\.txt","ends with .txt",name{"regex"})
       .parse(argc,argv);
   } catch(const std::exception& e) {
@@ -38,6 +41,7 @@ int main(int argc, char* argv[]) {
   TEST( i )
   TEST( s )
   TEST( b )
+  TEST( v.size() )
 
   return 0;
 }